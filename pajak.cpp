@@ -5,22 +5,102 @@
 #include <iomanip>   // Untuk std::setw, std::fixed, std::setprecision
 #include <thread>
 #include <chrono>
+#include <vector>
+#include <unordered_map> // Untuk agregasi laporan per wilayah
+#include <unordered_set> // Untuk tabel interning string
+#include <string_view>
+#include <memory>        // Untuk unique_ptr blok arena
+#include <cstring>       // Untuk memcpy
+#include <functional>    // Untuk std::ref
+#include <sstream>
+#include <cstdio>     // Untuk snprintf, remove
+#include <cstdlib>    // Untuk strtod, strtol
+#include <charconv>   // Untuk to_chars
+#include <cmath>      // Untuk isfinite
+#include <cerrno>     // Untuk errno, ERANGE
+#include <climits>    // Untuk INT_MIN, INT_MAX
+#include <queue>      // Untuk priority_queue pada merge sort eksternal
 using namespace std;
 
 #define MAX_USERS 100 // Batas maksimum jumlah pengguna
+#define REGION_CHUNK_MIN 4096 // Minimal jumlah record per thread saat agregasi wilayah
+#define PPH21_BRACKETS 5 // Jumlah lapisan tarif PPh 21
+#define INCOME_BANDS 6   // Jumlah kelompok penghasilan pada tabel distribusi simulasi
+#define APPROX_RECORD_BYTES (sizeof(User) + 64) // Perkiraan memori satu record beserta isi string-nya
+#define MAX_MERGE_FAN_IN 64 // Maksimal file run yang digabung sekaligus
+#define RANKING_PREVIEW 20  // Jumlah baris ranking yang ditampilkan di layar
+#define ARENA_BLOCK_SIZE 65536 // Ukuran satu blok arena string record
+#define INTERN_MAX_LENGTH 32   // String sepanjang ini atau kurang di-intern (nilai sama disimpan sekali)
 
 // ===== STRUCT =====
+// Teks record yang isinya disimpan di StringArena. Hanya berisi pointer + panjang,
+// jadi menyalin User tidak menyalin isi string dan tidak butuh alokasi.
+struct ArenaString {
+    const char* data = "";
+    size_t length = 0;
+
+    operator string_view() const { return string_view(data, length); }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    char operator[](size_t i) const { return data[i]; }
+};
+
+bool operator==(const ArenaString& a, const ArenaString& b) { return string_view(a) == string_view(b); }
+bool operator==(const ArenaString& a, string_view b) { return string_view(a) == b; }
+bool operator==(string_view a, const ArenaString& b) { return a == string_view(b); }
+bool operator!=(const ArenaString& a, const ArenaString& b) { return !(a == b); }
+bool operator!=(const ArenaString& a, string_view b) { return !(a == b); }
+bool operator!=(string_view a, const ArenaString& b) { return !(a == b); }
+
+ostream& operator<<(ostream& out, const ArenaString& text) {
+    return out << string_view(text); // setw tetap berlaku
+}
+
+// Arena per load: string record ditaruh berurutan di blok besar dan baru dilepas saat
+// arena direset (load berikutnya) atau dihancurkan. Blok dipakai ulang setelah reset.
+struct StringArena {
+    vector<unique_ptr<char[]>> blocks;      // Blok ARENA_BLOCK_SIZE, tetap disimpan saat reset
+    vector<unique_ptr<char[]>> largeBlocks; // String yang lebih besar dari satu blok
+    size_t current = 0; // Blok yang sedang diisi
+    size_t used = 0;    // Byte terpakai di blok current
+    unordered_set<string_view> interned; // Nilai pendek yang sudah ada di arena
+};
+
 struct User {
-    string username;
-    string password;
-    string nik;
-    string name;
+    ArenaString username;
+    ArenaString password;
+    ArenaString nik;
+    ArenaString name;
     double income = 0.0;
     double propertyValue = 0.0;
     double vehicleValue = 0.0;
     int dependents = 0;
     bool payment = false; // Status pembayaran (false = belum, true = sudah)
     bool isAdmin = false;
+    int regionCode = -1; // 6 digit awal NIK (PPKKCC), -1 jika NIK tidak valid
+};
+
+// Aturan tarif pajak. Nilai default = aturan yang berlaku sekarang,
+// skenario simulasi cukup mengubah sebagian nilainya.
+struct TaxRules {
+    string name = "Aturan berlaku";
+    double bracketLimits[PPH21_BRACKETS - 1] = {60000000, 250000000, 500000000, 5000000000};
+    double bracketRates[PPH21_BRACKETS] = {0.05, 0.15, 0.25, 0.30, 0.35};
+    double ptkpBase = 54000000;       // PTKP dasar per tahun
+    double ptkpPerDependent = 4500000; // Tambahan PTKP per tanggungan
+    int maxDependents = 3;
+    double exemptIncome = 4500000;     // Penghasilan/bln di bawah ini bebas PPh 21
+    double propertyRate = 0.001;
+    double vehicleRate = 0.02;
+};
+
+// Ringkasan pajak satu wilayah untuk laporan per wilayah
+struct RegionStats {
+    int registered = 0;    // Jumlah user terdaftar
+    int taxpayers = 0;     // Jumlah wajib pajak
+    int paidTaxpayers = 0; // Wajib pajak yang sudah bayar
+    double taxDue = 0.0;       // Total pajak terutang
+    double taxCollected = 0.0; // Total pajak yang sudah dibayar
 };
 
 
@@ -28,10 +108,21 @@ struct User {
 bool isLoggedIn = false;
 string currentUser;
 bool isAdmin = false;
-User loggedInUser;
+User* loggedInUser = nullptr; // Menunjuk langsung ke record di users[], bukan salinan
+User adminAccount; // Record untuk akun admin bawaan (tidak disimpan di file)
+StringArena userArena; // Arena string untuk record di users[], direset setiap readAllUsers()
 User users[MAX_USERS]; // Array C-style untuk menyimpan data user
 int userCount = 0;     // Jumlah user saat ini
 string filename = "user.txt"; // Nama file (gunakan nama berbeda)
+streamoff unloadedTailOffset = -1; // Posisi di user.txt mulai record yang tidak muat di users[], -1 jika semua dimuat
+string scenarioFilename = "skenario.txt"; // Daftar skenario tarif untuk simulasi
+const TaxRules currentTaxRules; // Aturan tarif yang berlaku
+string changeLogFilename = "user_changes.log"; // Log perubahan (JSONL, hanya ditambah)
+long long changeSeq = 0; // Nomor urut event terakhir di log perubahan
+bool changeLogNeedsNewline = false; // Log berakhir dengan baris terpotong
+long long memoryBudgetBytes = 64LL * 1024 * 1024; // Batas memori mode out-of-core
+string recomputeFilename = "pajak_hasil.txt"; // Hasil hitung ulang pajak mode out-of-core
+string rankingFilename = "ranking_pajak.txt"; // Hasil ranking pajak mode out-of-core
 
 // ===== FUNCTION DECLARATION =====
 int integerDetection();
@@ -54,18 +145,37 @@ void editUserData();
 void sortUsersByTax();
 void updateUserPaymentManually();
 void readAllUsers(); // Membaca semua user dari file ke array
-void writeAllUsers(); // Menulis semua user dari array ke file
-void parseLine(const string& line, User& u); // Parsing manual
+bool writeAllUsers(); // Menulis semua user dari array ke file, false jika gagal
+void parseLine(const string& line, User& u, StringArena& arena); // Parsing manual, string disimpan di arena
+ArenaString arenaStore(StringArena& arena, string_view text);  // Salin teks ke arena
+ArenaString arenaIntern(StringArena& arena, string_view text); // Salin teks ke arena, pakai ulang jika sudah ada
+void arenaReset(StringArena& arena);
 double calculateTotalTax(const User& user);
 bool compareUsersByTax(const User& a, const User& b); // Komparator untuk sort
 bool checkUsernameAvailability(const string& username); // NEW: Deklarasi fungsi baru
 int searchUserByNikRecursive(const string& nik, int index); // NEW: Deklarasi fungsi baru
 bool checkUsernameAvailability(const string& username);
 bool checkNikAvailability(const string& nik); // NEW: Deklarasi fungsi baru
+int parseRegionCode(string_view nik); // Ambil kode wilayah dari NIK
+void aggregateRegions(const User* data, int count, int divisor, unordered_map<int, RegionStats>& out);
+void printRegionalReport(const unordered_map<int, RegionStats>& stats, int level);
+void viewRegionalReport();
+void loadChangeSeq(); // Ambil nomor urut terakhir dari log perubahan
+void logUserInserted(const User& u);
+void logUserChanges(const User& before, const User& after);
+bool saveUserChange(User& record, const User& before); // Simpan + log, kembalikan data jika gagal
+void viewChangeLog();
+double calculateTaxPPh21WithRules(double monthlyIncome, int dependents, const TaxRules& rules);
+double calculateTotalTaxWithRules(const User& user, const TaxRules& rules);
+bool readScenarios(vector<TaxRules>& scenarios);
+void runScenarioSimulation();
+int askRegionLevel(); // Pilih level wilayah, 0 jika input tidak valid
+void showOutOfCoreMenu();
 
 // ===== MAIN =====
 int main() {
     readAllUsers(); // Muat data pengguna saat program dimulai
+    loadChangeSeq();
     int choice;
 
     while (true) {
@@ -116,7 +226,7 @@ void showLoading(string message, int dotCount = 3, int delayMs = 500) {
 
 // ===== Penghasilan kurang dari PTKP =====
 bool isExemptedFromPPh21(const User& user) {
-    return user.income < 4500000; // PTKP misalnya 4.5 juta
+    return user.income < currentTaxRules.exemptIncome; // PTKP misalnya 4.5 juta
 }
 
 bool hasPropertyOrVehicle(const User& user) {
@@ -141,13 +251,13 @@ void registerUser() {
     }
 
     User u;
-    string confirm;
+    string username, password, confirm, name, nik; // Dibaca dulu, baru disalin ke arena
 
     cout << "\n--- REGISTER ---\n";
     while (true) {
         cout << "Username        : ";
-        cin >> u.username;
-        if (!checkUsernameAvailability(u.username)) {
+        cin >> username;
+        if (!checkUsernameAvailability(username)) {
             cout << "Username sudah ada. Harap pilih username lain.\n";
             cin.ignore(numeric_limits<streamsize>::max(), '\n'); // Gunakan ini untuk membersihkan buffer
         } else {
@@ -155,22 +265,22 @@ void registerUser() {
         }
     }
 
-    cout << "Password        : "; cin >> u.password;
+    cout << "Password        : "; cin >> password;
     cout << "Konfirmasi Pass : "; cin >> confirm;
 
-    if (u.password != confirm) {
+    if (password != confirm) {
         cout << "Password tidak cocok!\n";
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
         return;
     }
 
-    cout << "Nama Lengkap    : "; cin.ignore(); getline(cin, u.name);
+    cout << "Nama Lengkap    : "; cin.ignore(); getline(cin, name);
 
     // NEW: Loop untuk memeriksa NIK
     while (true) {
         cout << "NIK             : ";
-        cin >> u.nik;
-        if (!checkNikAvailability(u.nik)) {
+        cin >> nik;
+        if (!checkNikAvailability(nik)) {
             cout << "NIK sudah terdaftar. Harap masukkan NIK lain.\n";
             cin.ignore(numeric_limits<streamsize>::max(), '\n'); // Membersihkan buffer
         } else {
@@ -192,12 +302,24 @@ void registerUser() {
         cout << "  Nilai kendaraan: "; u.vehicleValue=integerDetection();
     }
 
+    u.username = arenaStore(userArena, username);
+    u.password = arenaIntern(userArena, password);
+    u.name = arenaIntern(userArena, name);
+    u.nik = arenaStore(userArena, nik);
     u.isAdmin = false;
     u.payment = false;
+    u.regionCode = parseRegionCode(u.nik);
 
     users[userCount] = u; // Tambahkan ke array
     userCount++;
-    writeAllUsers(); // Simpan ke file
+    if (!writeAllUsers()) { // Simpan ke file, batalkan jika gagal
+        userCount--;
+        users[userCount] = User();
+        cout << "Registrasi gagal disimpan.\n";
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        return;
+    }
+    logUserInserted(u);
     cout << "Registrasi berhasil!\n";
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
 }
@@ -226,9 +348,10 @@ void loginUser() {
         isLoggedIn = true;
         isAdmin = true;
         currentUser = uname;
-        loggedInUser.username = "admin";
-        loggedInUser.name = "Administrator";
-        loggedInUser.isAdmin = true;
+        adminAccount.username = arenaIntern(userArena, "admin");
+        adminAccount.name = arenaIntern(userArena, "Administrator");
+        adminAccount.isAdmin = true;
+        loggedInUser = &adminAccount;
         cout << "✅ Login berhasil! Selamat datang, Admin.\n";
         return;
     }
@@ -240,7 +363,7 @@ void loginUser() {
             isLoggedIn = true;
             isAdmin = users[i].isAdmin;
             currentUser = users[i].username;
-            loggedInUser = users[i]; // Salin data
+            loggedInUser = &users[i]; // Cukup simpan alamat record, tidak perlu salin
             cout << "Login berhasil. Selamat datang, " << users[i].name << "!\n";
             found = true;
             break;
@@ -258,7 +381,7 @@ void logoutUser() {
     isLoggedIn = false;
     isAdmin = false;
     currentUser = "";
-    loggedInUser = User(); // Reset
+    loggedInUser = nullptr; // Reset
 }
 
 // ===== DETECT ROLE =====
@@ -329,7 +452,11 @@ void showAdminMenu() {
         cout << "3. Edit Data User\n";
         cout << "4. Sorting User Berdasarkan Pajak\n";
         cout << "5. Update Status Pembayaran User\n";
-        cout << "6. Logout\n";
+        cout << "6. Laporan Pajak Per Wilayah\n";
+        cout << "7. Lihat Log Perubahan Data\n";
+        cout << "8. Simulasi Skenario Tarif Pajak\n";
+        cout << "9. Mode Out-of-Core (Data Besar)\n";
+        cout << "10. Logout\n";
         cout << "Pilih: ";
         cin >> ch;
         if (cin.fail()) { cout << "Input salah.\n"; cin.clear(); cin.ignore(10000, '\n'); continue; }
@@ -341,7 +468,11 @@ void showAdminMenu() {
             case 3: editUserData(); break;
             case 4: sortUsersByTax(); break;
             case 5: updateUserPaymentManually(); break;
-            case 6: logoutUser(); return;
+            case 6: viewRegionalReport(); break;
+            case 7: viewChangeLog(); break;
+            case 8: runScenarioSimulation(); break;
+            case 9: showOutOfCoreMenu(); break;
+            case 10: logoutUser(); return;
             default: cout << "Pilihan salah.\n";
         }
     }
@@ -359,17 +490,17 @@ bool checkNikAvailability(const string& nik) {
 }
 void viewProfile() {
     cout << "\n--- PROFIL ANDA ---\n";
-    cout << "Username      : " << loggedInUser.username << "\n";
-    cout << "Nama          : " << loggedInUser.name << "\n";
-    cout << "NIK           : " << loggedInUser.nik << "\n";
-    cout << "Penghasilan   : Rp " << fixed << setprecision(2) << loggedInUser.income << "\n";
-    cout << "Properti      : Rp " << fixed << setprecision(2) << loggedInUser.propertyValue << "\n";
-    cout << "Kendaraan     : Rp " << fixed << setprecision(2) << loggedInUser.vehicleValue << "\n";
-    cout << "Tanggungan    : " << loggedInUser.dependents << "\n";
-    cout << "Status Pajak  : " << (loggedInUser.payment ? "SUDAH BAYAR" : "BELUM BAYAR") << "\n";
-
-    bool exemptPPh21 = isExemptedFromPPh21(loggedInUser);
-    bool hasAssets = hasPropertyOrVehicle(loggedInUser);
+    cout << "Username      : " << loggedInUser->username << "\n";
+    cout << "Nama          : " << loggedInUser->name << "\n";
+    cout << "NIK           : " << loggedInUser->nik << "\n";
+    cout << "Penghasilan   : Rp " << fixed << setprecision(2) << loggedInUser->income << "\n";
+    cout << "Properti      : Rp " << fixed << setprecision(2) << loggedInUser->propertyValue << "\n";
+    cout << "Kendaraan     : Rp " << fixed << setprecision(2) << loggedInUser->vehicleValue << "\n";
+    cout << "Tanggungan    : " << loggedInUser->dependents << "\n";
+    cout << "Status Pajak  : " << (loggedInUser->payment ? "SUDAH BAYAR" : "BELUM BAYAR") << "\n";
+
+    bool exemptPPh21 = isExemptedFromPPh21(*loggedInUser);
+    bool hasAssets = hasPropertyOrVehicle(*loggedInUser);
 
     if (exemptPPh21 && !hasAssets) {
         cout << "\n⚠️ Anda tidak diwajibkan membayar pajak.\n";
@@ -378,17 +509,17 @@ void viewProfile() {
 }
 
 void calculateTax() {
-    bool exemptPPh21 = isExemptedFromPPh21(loggedInUser);
-    bool hasAssets = hasPropertyOrVehicle(loggedInUser);
+    bool exemptPPh21 = isExemptedFromPPh21(*loggedInUser);
+    bool hasAssets = hasPropertyOrVehicle(*loggedInUser);
 
     if (exemptPPh21 && !hasAssets) {
         cout << "\n⚠️ Anda tidak diwajibkan membayar pajak.\n";
         return;
     }
 
-    double pph21 = exemptPPh21 ? 0 : calculateTaxPPh21(loggedInUser.income, loggedInUser.dependents);
-    double propertyTax = calculatePropertyTax(loggedInUser.propertyValue);
-    double vehicleTax = calculateVehicleTax(loggedInUser.vehicleValue);
+    double pph21 = exemptPPh21 ? 0 : calculateTaxPPh21(loggedInUser->income, loggedInUser->dependents);
+    double propertyTax = calculatePropertyTax(loggedInUser->propertyValue);
+    double vehicleTax = calculateVehicleTax(loggedInUser->vehicleValue);
     double totalTax = pph21 + propertyTax + vehicleTax;
 
     cout << "\n--- PERHITUNGAN PAJAK ANDA ---" << endl;
@@ -400,20 +531,20 @@ void calculateTax() {
 }
 
 void updatePaymentStatus() {
-    bool exemptPPh21 = isExemptedFromPPh21(loggedInUser);
-    bool hasAssets = hasPropertyOrVehicle(loggedInUser);
+    bool exemptPPh21 = isExemptedFromPPh21(*loggedInUser);
+    bool hasAssets = hasPropertyOrVehicle(*loggedInUser);
 
     if (exemptPPh21 && !hasAssets) {
         cout << "\n⚠️ Anda tidak diwajibkan membayar pajak, sehingga tidak perlu update status bayar pajak.\n";
         return;
     }
 
-    if (loggedInUser.payment) {
+    if (loggedInUser->payment) {
         cout << "Anda sudah membayar pajak tahun ini. ✅\n";
         return;
     }
 
-    double total = calculateTotalTax(loggedInUser);
+    double total = calculateTotalTax(*loggedInUser);
     cout << "\nJumlah pajak yang harus dibayar: Rp " << fixed << setprecision(2) << total << endl;
     cout << "Lanjutkan ke pembayaran? (y/n): ";
     char confirm;
@@ -439,28 +570,24 @@ void updatePaymentStatus() {
     cin.get(); // tunggu input enter
 
     showLoading("Memproses pembayaran", 5, 800);
-    cout << "Pembayaran berhasil! ✅\n";
 
-    // Update status
-    for (int i = 0; i < userCount; i++) {
-        if (users[i].username == loggedInUser.username) {
-            users[i].payment = true;
-            loggedInUser.payment = true;
-            break;
-        }
+    // Update status (loggedInUser menunjuk langsung ke record di users[])
+    User before = *loggedInUser;
+    loggedInUser->payment = true;
+    if (saveUserChange(*loggedInUser, before)) {
+        cout << "Pembayaran berhasil! ✅\n";
     }
-    writeAllUsers();
 }
 
 void viewTaxReport() {
     cout << "\n--- LAPORAN PAJAK TAHUNAN ---" << endl;
-    cout << "Username      : " << loggedInUser.username << "\n";
-    cout << "Nama          : " << loggedInUser.name << "\n";
-    cout << "NIK           : " << loggedInUser.nik << "\n";
+    cout << "Username      : " << loggedInUser->username << "\n";
+    cout << "Nama          : " << loggedInUser->name << "\n";
+    cout << "NIK           : " << loggedInUser->nik << "\n";
     cout << "------------------------------------------" << endl;
 
-    bool exemptPPh21 = isExemptedFromPPh21(loggedInUser);
-    bool hasAssets = hasPropertyOrVehicle(loggedInUser);
+    bool exemptPPh21 = isExemptedFromPPh21(*loggedInUser);
+    bool hasAssets = hasPropertyOrVehicle(*loggedInUser);
 
     if (exemptPPh21 && !hasAssets) {
         cout << "\n⚠️ Anda tidak diwajibkan membayar pajak.\n";
@@ -469,7 +596,7 @@ void viewTaxReport() {
 
     calculateTax();
     cout << "------------------------------------------" << endl;
-    cout << "Status Pembayaran : " << (loggedInUser.payment ? "✅ SUDAH BAYAR" : "❌ BELUM BAYAR") << endl;
+    cout << "Status Pembayaran : " << (loggedInUser->payment ? "✅ SUDAH BAYAR" : "❌ BELUM BAYAR") << endl;
 }
 
 // ===== UTILITAS ADMIN =====
@@ -483,7 +610,7 @@ int searchUserByNikRecursive(const string& nik, int index) {
 
 // Fungsi pengecekan wajib pajak (income atau properti/kendaraan)
 bool isRequiredToPayTax(const User& user) {
-    if (user.income >= 4500000) return true;
+    if (user.income >= currentTaxRules.exemptIncome) return true;
     if (user.propertyValue > 0) return true;
     if (user.vehicleValue > 0) return true;
     return false;
@@ -515,6 +642,213 @@ void viewAllUsers() {
     cout << string(100, '-') << endl;
 }
 
+// ===== LAPORAN PER WILAYAH =====
+// NIK: 2 digit provinsi, 2 digit kabupaten/kota, 2 digit kecamatan, lalu sisanya
+int parseRegionCode(string_view nik) {
+    if (nik.size() < 6) return -1;
+    int code = 0;
+    for (int i = 0; i < 6; i++) {
+        if (nik[i] < '0' || nik[i] > '9') return -1;
+        code = code * 10 + (nik[i] - '0');
+    }
+    return code;
+}
+
+// Nama provinsi berdasarkan kode Kemendagri (2 digit awal NIK)
+string provinceName(int code) {
+    switch (code) {
+        case 11: return "Aceh";
+        case 12: return "Sumatera Utara";
+        case 13: return "Sumatera Barat";
+        case 14: return "Riau";
+        case 15: return "Jambi";
+        case 16: return "Sumatera Selatan";
+        case 17: return "Bengkulu";
+        case 18: return "Lampung";
+        case 19: return "Kep. Bangka Belitung";
+        case 21: return "Kepulauan Riau";
+        case 31: return "DKI Jakarta";
+        case 32: return "Jawa Barat";
+        case 33: return "Jawa Tengah";
+        case 34: return "DI Yogyakarta";
+        case 35: return "Jawa Timur";
+        case 36: return "Banten";
+        case 51: return "Bali";
+        case 52: return "Nusa Tenggara Barat";
+        case 53: return "Nusa Tenggara Timur";
+        case 61: return "Kalimantan Barat";
+        case 62: return "Kalimantan Tengah";
+        case 63: return "Kalimantan Selatan";
+        case 64: return "Kalimantan Timur";
+        case 65: return "Kalimantan Utara";
+        case 71: return "Sulawesi Utara";
+        case 72: return "Sulawesi Tengah";
+        case 73: return "Sulawesi Selatan";
+        case 74: return "Sulawesi Tenggara";
+        case 75: return "Gorontalo";
+        case 76: return "Sulawesi Barat";
+        case 81: return "Maluku";
+        case 82: return "Maluku Utara";
+        case 91: return "Papua";
+        case 92: return "Papua Barat";
+        case 93: return "Papua Selatan";
+        case 94: return "Papua Tengah";
+        case 95: return "Papua Pegunungan";
+        case 96: return "Papua Barat Daya";
+        default: return "-";
+    }
+}
+
+// Format kode wilayah sesuai level: 1 = "32", 2 = "32.73", 3 = "32.73.05"
+string formatRegionKey(int key, int level) {
+    if (key < 0) return "Tidak valid";
+    string digits = to_string(key);
+    digits.insert(0, level * 2 - digits.size(), '0');
+    string result = digits.substr(0, 2);
+    for (int i = 2; i < level * 2; i += 2) {
+        result += "." + digits.substr(i, 2);
+    }
+    return result;
+}
+
+void mergeRegionStats(RegionStats& into, const RegionStats& from) {
+    into.registered += from.registered;
+    into.taxpayers += from.taxpayers;
+    into.paidTaxpayers += from.paidTaxpayers;
+    into.taxDue += from.taxDue;
+    into.taxCollected += from.taxCollected;
+}
+
+// Agregasi satu potongan data ke hash map milik potongan itu sendiri
+void aggregateRegionsChunk(const User* data, int count, int divisor, unordered_map<int, RegionStats>& out) {
+    for (int i = 0; i < count; i++) {
+        const User& u = data[i];
+        if (u.isAdmin) continue;
+
+        int key = (u.regionCode < 0) ? -1 : u.regionCode / divisor;
+        RegionStats& s = out[key];
+        s.registered++;
+        if (!isRequiredToPayTax(u)) continue;
+
+        double tax = calculateTotalTax(u);
+        s.taxpayers++;
+        s.taxDue += tax;
+        if (u.payment) {
+            s.paidTaxpayers++;
+            s.taxCollected += tax;
+        }
+    }
+}
+
+// Data dibagi per potongan ke beberapa thread, hasil tiap thread digabung di akhir.
+// Untuk data kecil cukup satu thread karena biaya membuat thread lebih besar.
+void aggregateRegions(const User* data, int count, int divisor, unordered_map<int, RegionStats>& out) {
+    int threadCount = (int)thread::hardware_concurrency();
+    threadCount = min(threadCount, count / REGION_CHUNK_MIN);
+    if (threadCount <= 1) {
+        aggregateRegionsChunk(data, count, divisor, out);
+        return;
+    }
+
+    vector<unordered_map<int, RegionStats>> partial(threadCount);
+    vector<thread> workers;
+    int chunkSize = (count + threadCount - 1) / threadCount;
+    for (int t = 0; t < threadCount; t++) {
+        int start = t * chunkSize;
+        int length = min(chunkSize, count - start);
+        if (length <= 0) break;
+        workers.emplace_back(aggregateRegionsChunk, data + start, length, divisor, ref(partial[t]));
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+
+    for (size_t t = 0; t < partial.size(); t++) {
+        for (const auto& entry : partial[t]) {
+            mergeRegionStats(out[entry.first], entry.second);
+        }
+    }
+}
+
+// Persentase wajib pajak yang sudah bayar, "-" jika wilayah tidak punya wajib pajak
+string formatCompliance(const RegionStats& s) {
+    if (s.taxpayers == 0) return "-";
+    ostringstream out;
+    out << fixed << setprecision(1) << (100.0 * s.paidTaxpayers / s.taxpayers);
+    return out.str();
+}
+
+void printRegionalReport(const unordered_map<int, RegionStats>& stats, int level) {
+    vector<int> keys;
+    for (const auto& entry : stats) keys.push_back(entry.first);
+    sort(keys.begin(), keys.end());
+
+    cout << left << setw(13) << "Wilayah"
+         << setw(22) << "Provinsi"
+         << setw(10) << "User"
+         << setw(8) << "Wajib"
+         << setw(18) << "Terutang (Rp)"
+         << setw(18) << "Terbayar (Rp)"
+         << setw(18) << "Tunggakan (Rp)"
+         << setw(10) << "Patuh (%)" << endl;
+    cout << string(117, '-') << endl;
+
+    RegionStats total;
+    for (size_t i = 0; i < keys.size(); i++) {
+        const RegionStats& s = stats.at(keys[i]);
+        int provinceCode = (keys[i] < 0) ? -1 : keys[i] / (level == 1 ? 1 : (level == 2 ? 100 : 10000));
+        cout << left << setw(13) << formatRegionKey(keys[i], level)
+             << setw(22) << provinceName(provinceCode)
+             << setw(10) << s.registered
+             << setw(8) << s.taxpayers
+             << setw(18) << fixed << setprecision(2) << s.taxDue
+             << setw(18) << s.taxCollected
+             << setw(18) << (s.taxDue - s.taxCollected)
+             << setw(10) << formatCompliance(s) << endl;
+        mergeRegionStats(total, s);
+    }
+
+    cout << string(117, '-') << endl;
+    cout << left << setw(35) << "TOTAL"
+         << setw(10) << total.registered
+         << setw(8) << total.taxpayers
+         << setw(18) << fixed << setprecision(2) << total.taxDue
+         << setw(18) << total.taxCollected
+         << setw(18) << (total.taxDue - total.taxCollected)
+         << setw(10) << formatCompliance(total) << endl;
+}
+
+int askRegionLevel() {
+    cout << "Kelompokkan berdasarkan:\n1. Provinsi\n2. Kabupaten/Kota\n3. Kecamatan\n";
+    cout << "Pilih: ";
+    int level;
+    cin >> level;
+    if (cin.fail() || level < 1 || level > 3) {
+        cout << "Pilihan tidak valid.\n";
+        cin.clear();
+        cin.ignore(10000, '\n');
+        return 0;
+    }
+    cin.ignore(10000, '\n');
+    return level;
+}
+
+void viewRegionalReport() {
+    cout << "\n--- LAPORAN PAJAK PER WILAYAH ---\n";
+    if (userCount == 0) {
+        cout << "Tidak ada data user terdaftar.\n";
+        return;
+    }
+
+    int level = askRegionLevel();
+    if (level == 0) return;
+
+    int divisor = (level == 1) ? 10000 : (level == 2 ? 100 : 1);
+    unordered_map<int, RegionStats> stats;
+    aggregateRegions(users, userCount, divisor, stats);
+    printRegionalReport(stats, level);
+}
+
 void searchUser() {
       string nik;
     cout << "Masukkan NIK user yang dicari: "; // Berubah dari 'username' menjadi 'NIK'
@@ -562,20 +896,33 @@ void editUserData() {
     if (cin.fail()) { cout << "Input salah.\n"; cin.clear(); cin.ignore(10000, '\n'); return; }
     cin.ignore(10000, '\n');
 
+    User before = users[userIndex]; // Untuk mencatat nilai lama di log perubahan
+    string text; // Input teks baru, disalin ke arena (nilai lama tetap ada untuk log)
     switch (choice) {
-        case 1: cout << "Nama baru: "; getline(cin, users[userIndex].name); break;
-        case 2: cout << "NIK baru: "; cin >> users[userIndex].nik; cin.ignore(); break;
+        case 1:
+            cout << "Nama baru: "; getline(cin, text);
+            users[userIndex].name = arenaIntern(userArena, text);
+            break;
+        case 2:
+            cout << "NIK baru: "; cin >> text; cin.ignore();
+            users[userIndex].nik = arenaStore(userArena, text);
+            users[userIndex].regionCode = parseRegionCode(users[userIndex].nik);
+            break;
         case 3: cout << "Penghasilan baru: "; cin >> users[userIndex].income; cin.ignore(); break;
         case 4: cout << "Nilai properti baru: "; cin >> users[userIndex].propertyValue; cin.ignore(); break;
         case 5: cout << "Nilai kendaraan baru: "; cin >> users[userIndex].vehicleValue; cin.ignore(); break;
         case 6: cout << "Jumlah tanggungan baru: "; cin >> users[userIndex].dependents; cin.ignore(); break;
-        case 7: cout << "Password baru: "; cin >> users[userIndex].password; cin.ignore(); break;
+        case 7:
+            cout << "Password baru: "; cin >> text; cin.ignore();
+            users[userIndex].password = arenaIntern(userArena, text);
+            break;
         case 0: cout << "Edit dibatalkan.\n"; return;
         default: cout << "Pilihan tidak valid.\n"; return;
     }
 
-    writeAllUsers();
-    cout << "Data user berhasil diperbarui.\n";
+    if (saveUserChange(users[userIndex], before)) {
+        cout << "Data user berhasil diperbarui.\n";
+    }
 }
 
 void sortUsersByTax() {
@@ -584,17 +931,17 @@ void sortUsersByTax() {
         return;
     }
 
-    // Bubble Sort
-    for (int i = 0; i < userCount - 1; i++) {
-        for (int j = 0; j < userCount - i - 1; j++) {
-            if (calculateTotalTax(users[j]) < calculateTotalTax(users[j + 1])) {
-                // Tukar posisi users[j] dan users[j + 1]
-                User temp = users[j];
-                users[j] = users[j + 1];
-                users[j + 1] = temp;
-            }
-        }
+    // Yang diurutkan hanya indeks record, data di users[] tidak dipindah/disalin.
+    // Pajak dihitung sekali per user, stable_sort menjaga urutan user dengan pajak sama.
+    int order[MAX_USERS];
+    double taxes[MAX_USERS];
+    for (int i = 0; i < userCount; i++) {
+        order[i] = i;
+        taxes[i] = calculateTotalTax(users[i]);
     }
+    stable_sort(order, order + userCount, [&taxes](int a, int b) {
+        return taxes[a] > taxes[b];
+    });
 
     cout << "\n--- USER BERDASARKAN PAJAK (TERBESAR KE TERKECIL) ---\n";
     cout << left << setw(15) << "Username"
@@ -603,9 +950,10 @@ void sortUsersByTax() {
     cout << string(60, '-') << endl;
 
     for (int i=0; i < userCount; i++) {
-         cout << left << setw(15) << users[i].username
-             << setw(25) << users[i].name
-             << setw(20) << fixed << setprecision(2) << calculateTotalTax(users[i]) << endl;
+         const User& u = users[order[i]];
+         cout << left << setw(15) << u.username
+             << setw(25) << u.name
+             << setw(20) << fixed << setprecision(2) << taxes[order[i]] << endl;
     }
      cout << string(60, '-') << endl;
 }
@@ -637,75 +985,608 @@ void updateUserPaymentManually() {
     cin >> choice;
     cin.ignore(10000, '\n');
 
+    User before = users[userIndex];
     if (choice == 'y' || choice == 'Y') {
         users[userIndex].payment = true;
-        cout << "Status diubah menjadi SUDAH BAYAR.\n";
-        writeAllUsers();
+        if (saveUserChange(users[userIndex], before)) cout << "Status diubah menjadi SUDAH BAYAR.\n";
     } else if (choice == 'n' || choice == 'N') {
         users[userIndex].payment = false;
-        cout << "Status diubah menjadi BELUM BAYAR.\n";
-        writeAllUsers();
+        if (saveUserChange(users[userIndex], before)) cout << "Status diubah menjadi BELUM BAYAR.\n";
     } else {
         cout << "Perubahan dibatalkan.\n";
     }
 }
 
+// ===== SIMULASI SKENARIO TARIF =====
+// Format skenario.txt, satu skenario per baris (baris diawali '#' diabaikan):
+//   nama|kunci=nilai|kunci=nilai...
+// Kunci: tarif1..tarif5 (%), batas1..batas4 (Rp PKP/thn), ptkpDasar, ptkpTanggungan,
+//        maxTanggungan, batasBebas (Rp/bln), tarifProperti (%), tarifKendaraan (%)
+// Contoh: tarif15jadi12|tarif2=12
+//         tanggungan4|maxTanggungan=4
+// Kunci yang tidak ditulis memakai aturan yang berlaku.
+
+bool applyScenarioSetting(TaxRules& rules, const string& key, double value) {
+    if (key.size() == 6 && key.compare(0, 5, "tarif") == 0 && key[5] >= '1' && key[5] <= '0' + PPH21_BRACKETS) {
+        rules.bracketRates[key[5] - '1'] = value / 100;
+    } else if (key.size() == 6 && key.compare(0, 5, "batas") == 0 && key[5] >= '1' && key[5] < '0' + PPH21_BRACKETS) {
+        rules.bracketLimits[key[5] - '1'] = value;
+    } else if (key == "ptkpDasar") {
+        rules.ptkpBase = value;
+    } else if (key == "ptkpTanggungan") {
+        rules.ptkpPerDependent = value;
+    } else if (key == "maxTanggungan") {
+        rules.maxDependents = (int)value;
+    } else if (key == "batasBebas") {
+        rules.exemptIncome = value;
+    } else if (key == "tarifProperti") {
+        rules.propertyRate = value / 100;
+    } else if (key == "tarifKendaraan") {
+        rules.vehicleRate = value / 100;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Cek aturan hasil skenario masih masuk akal, alasan ditulis ke reason jika tidak
+bool validateScenario(const TaxRules& rules, string& reason) {
+    for (int i = 0; i < PPH21_BRACKETS - 1; i++) {
+        double previous = (i == 0) ? 0 : rules.bracketLimits[i - 1];
+        if (rules.bracketLimits[i] <= previous) {
+            reason = "batas" + to_string(i + 1) + " harus lebih besar dari " + (i == 0 ? "0" : "batas" + to_string(i));
+            return false;
+        }
+    }
+    for (int i = 0; i < PPH21_BRACKETS; i++) {
+        if (rules.bracketRates[i] < 0 || rules.bracketRates[i] > 1) {
+            reason = "tarif" + to_string(i + 1) + " harus di antara 0-100%";
+            return false;
+        }
+    }
+    if (rules.propertyRate < 0 || rules.propertyRate > 1 || rules.vehicleRate < 0 || rules.vehicleRate > 1) {
+        reason = "tarifProperti/tarifKendaraan harus di antara 0-100%";
+        return false;
+    }
+    if (rules.ptkpBase < 0 || rules.ptkpPerDependent < 0 || rules.maxDependents < 0 || rules.exemptIncome < 0) {
+        reason = "ptkpDasar, ptkpTanggungan, maxTanggungan dan batasBebas tidak boleh negatif";
+        return false;
+    }
+    return true;
+}
+
+bool readScenarios(vector<TaxRules>& scenarios) {
+    ifstream file(scenarioFilename);
+    if (!file.is_open()) return false;
+
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+
+        TaxRules rules;
+        size_t start = 0;
+        size_t end = line.find('|');
+        rules.name = line.substr(0, end);
+        while (end != string::npos) {
+            start = end + 1;
+            end = line.find('|', start);
+            string setting = line.substr(start, end == string::npos ? string::npos : end - start);
+            size_t eq = setting.find('=');
+            bool valid = (eq != string::npos);
+            if (valid) {
+                try { valid = applyScenarioSetting(rules, setting.substr(0, eq), stod(setting.substr(eq + 1))); }
+                catch (...) { valid = false; }
+            }
+            if (!valid) {
+                cout << "Peringatan: pengaturan '" << setting << "' di baris " << lineNumber << " diabaikan.\n";
+            }
+        }
+
+        string reason;
+        if (!validateScenario(rules, reason)) {
+            cout << "Peringatan: skenario '" << rules.name << "' di baris " << lineNumber
+                 << " dilewati (" << reason << ").\n";
+            continue;
+        }
+        scenarios.push_back(rules);
+    }
+    file.close();
+    return true;
+}
+
+// Kelompok penghasilan per bulan untuk tabel distribusi
+int incomeBand(double monthlyIncome) {
+    if (monthlyIncome < currentTaxRules.exemptIncome) return 0;
+    if (monthlyIncome < 10000000) return 1;
+    if (monthlyIncome < 25000000) return 2;
+    if (monthlyIncome < 50000000) return 3;
+    if (monthlyIncome < 100000000) return 4;
+    return 5;
+}
+
+const char* incomeBandLabel(int band) {
+    static const char* labels[INCOME_BANDS] = {
+        "< batas bebas", "batas - 10 jt", "10 - 25 jt", "25 - 50 jt", "50 - 100 jt", ">= 100 jt"
+    };
+    return labels[band];
+}
+
+// Hasil simulasi satu skenario
+struct ScenarioResult {
+    double revenue = 0.0;
+    int taxpayers = 0;
+    int taxIncreased = 0; // Jumlah user yang pajaknya naik dibanding aturan berlaku
+    int taxDecreased = 0;
+    double bandRevenue[INCOME_BANDS] = {0};
+};
+
+void runScenarioSimulation() {
+    cout << "\n--- SIMULASI SKENARIO TARIF PAJAK ---\n";
+    vector<TaxRules> scenarios;
+    scenarios.push_back(currentTaxRules); // Skenario 0 = pembanding
+    if (!readScenarios(scenarios)) {
+        cout << "File " << scenarioFilename << " tidak ditemukan.\n";
+        cout << "Format per baris: nama|kunci=nilai|... (contoh: tarif15jadi12|tarif2=12)\n";
+        return;
+    }
+    if (scenarios.size() == 1) {
+        cout << "Tidak ada skenario di " << scenarioFilename << ".\n";
+        return;
+    }
+
+    // Satu kali lewat data: semua skenario dihitung untuk tiap user sekaligus
+    size_t scenarioCount = scenarios.size();
+    vector<ScenarioResult> results(scenarioCount);
+    vector<double> taxes(scenarioCount);
+    int bandUsers[INCOME_BANDS] = {0};
+    for (int i = 0; i < userCount; i++) {
+        const User& u = users[i];
+        if (u.isAdmin) continue;
+
+        int band = incomeBand(u.income);
+        bandUsers[band]++;
+        for (size_t s = 0; s < scenarioCount; s++) {
+            taxes[s] = calculateTotalTaxWithRules(u, scenarios[s]);
+        }
+        for (size_t s = 0; s < scenarioCount; s++) {
+            ScenarioResult& r = results[s];
+            r.revenue += taxes[s];
+            r.bandRevenue[band] += taxes[s];
+            if (taxes[s] > 0) r.taxpayers++;
+            if (taxes[s] > taxes[0] + 0.005) r.taxIncreased++;
+            else if (taxes[s] < taxes[0] - 0.005) r.taxDecreased++;
+        }
+    }
+
+    double baseRevenue = results[0].revenue;
+    cout << left << setw(25) << "Skenario"
+         << setw(8) << "Wajib"
+         << setw(20) << "Penerimaan (Rp)"
+         << setw(20) << "Selisih (Rp)"
+         << setw(10) << "Selisih %"
+         << setw(8) << "Naik"
+         << setw(8) << "Turun" << endl;
+    cout << string(99, '-') << endl;
+    for (size_t s = 0; s < scenarioCount; s++) {
+        const ScenarioResult& r = results[s];
+        double delta = r.revenue - baseRevenue;
+        cout << left << setw(25) << scenarios[s].name
+             << setw(8) << r.taxpayers
+             << setw(20) << fixed << setprecision(2) << r.revenue
+             << setw(20) << delta
+             << setw(10) << setprecision(1) << (baseRevenue > 0 ? 100.0 * delta / baseRevenue : 0.0)
+             << setw(8) << r.taxIncreased
+             << setw(8) << r.taxDecreased << endl;
+    }
+    cout << string(99, '-') << endl;
+
+    // Tabel distribusi per kelompok penghasilan untuk tiap skenario
+    for (size_t s = 1; s < scenarioCount; s++) {
+        cout << "\nDistribusi skenario: " << scenarios[s].name << "\n";
+        cout << left << setw(17) << "Penghasilan/bln"
+             << setw(8) << "User"
+             << setw(20) << "Berlaku (Rp)"
+             << setw(20) << "Skenario (Rp)"
+             << setw(20) << "Selisih (Rp)"
+             << setw(20) << "Rata2/User (Rp)" << endl;
+        cout << string(105, '-') << endl;
+        for (int b = 0; b < INCOME_BANDS; b++) {
+            double delta = results[s].bandRevenue[b] - results[0].bandRevenue[b];
+            cout << left << setw(17) << incomeBandLabel(b)
+                 << setw(8) << bandUsers[b]
+                 << setw(20) << fixed << setprecision(2) << results[0].bandRevenue[b]
+                 << setw(20) << results[s].bandRevenue[b]
+                 << setw(20) << delta
+                 << setw(20) << (bandUsers[b] > 0 ? delta / bandUsers[b] : 0.0) << endl;
+        }
+    }
+}
+
+// ===== LOG PERUBAHAN DATA (CHANGE DATA CAPTURE) =====
+// Setiap perubahan data user ditambahkan ke user_changes.log, satu event JSON per baris:
+//   {"seq":1,"ts":...,"op":"insert","user":"budi","record":{...}}
+//   {"seq":2,"ts":...,"op":"update","user":"budi","field":"income","old":5000000,"new":7000000}
+//   {"seq":3,"ts":...,"op":"payment","user":"budi","old":false,"new":true}
+// "seq" selalu naik, sehingga sistem lain cukup membaca event setelah seq terakhir yang diprosesnya.
+// Password tidak pernah ditulis ke log, hanya dicatat bahwa password berubah.
+
+string jsonEscape(string_view text) {
+    string result;
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        switch (c) {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char hex[7];
+                    snprintf(hex, sizeof(hex), "\\u%04x", c);
+                    result += hex;
+                } else {
+                    result += c;
+                }
+        }
+    }
+    return result;
+}
+
+string jsonString(string_view text) {
+    return "\"" + jsonEscape(text) + "\"";
+}
+
+// Representasi terpendek yang tetap menghasilkan nilai double yang sama persis saat dibaca ulang
+string jsonNumber(double value) {
+    if (!isfinite(value)) return "null"; // JSON tidak punya inf/nan
+    char buffer[512]; // Cukup untuk notasi desimal double terbesar
+    to_chars_result result = to_chars(buffer, buffer + sizeof(buffer), value, chars_format::fixed);
+    if (result.ec != errc()) return "null";
+    return string(buffer, result.ptr);
+}
+
+// Ambil nilai "seq" dari satu baris log, -1 jika baris tidak valid.
+// Hanya baris utuh yang diterima: diakhiri '}' dan angka seq diikuti ','
+// (baris terpotong seperti {"seq":12 dari 123 tidak boleh terbaca sebagai 12).
+long long parseChangeSeq(const string& line) {
+    const string key = "{\"seq\":";
+    if (line.compare(0, key.size(), key) != 0) return -1;
+
+    size_t end = line.size();
+    if (end > 0 && line[end - 1] == '\r') end--;
+    if (end == 0 || line[end - 1] != '}') return -1;
+
+    long long seq = 0;
+    size_t i = key.size();
+    size_t digitsStart = i;
+    while (i < end && line[i] >= '0' && line[i] <= '9') {
+        if (i - digitsStart >= 18) return -1; // Terlalu panjang untuk long long
+        seq = seq * 10 + (line[i] - '0');
+        i++;
+    }
+    if (i == digitsStart || i >= end || line[i] != ',') return -1;
+    return seq;
+}
+
+// Baca mundur dari akhir file sampai ketemu baris dengan seq yang valid. Baris terakhir
+// bisa terpotong jika penulisan sebelumnya gagal; seq tidak boleh kembali ke awal.
+void loadChangeSeq() {
+    changeSeq = 0;
+    changeLogNeedsNewline = false;
+    ifstream file(changeLogFilename, ios::binary);
+    if (!file.is_open()) return;
+
+    file.seekg(0, ios::end);
+    streamoff pos = file.tellg();
+    if (pos > 0) {
+        file.seekg(pos - 1);
+        changeLogNeedsNewline = (file.get() != '\n');
+    }
+
+    string line;
+    while (pos > 0) {
+        file.seekg(--pos);
+        char c = (char)file.get();
+        if (c != '\n') {
+            if (c != '\r') line.insert(line.begin(), c);
+            if (pos > 0) continue; // Baris pertama file tidak diawali newline
+        }
+        long long seq = line.empty() ? -1 : parseChangeSeq(line);
+        if (seq > 0) {
+            changeSeq = seq;
+            return;
+        }
+        line.clear();
+    }
+}
+
+void appendChangeEvent(const string& op, string_view username, const string& payload) {
+    ofstream file(changeLogFilename, ios::app);
+    if (!file.is_open()) {
+        cerr << "Error: Tidak bisa membuka file " << changeLogFilename << " untuk ditulis.\n";
+        return;
+    }
+
+    long long timestamp = chrono::duration_cast<chrono::seconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+    if (changeLogNeedsNewline) {
+        file << "\n"; // Jangan sambung event baru ke baris yang terpotong
+        changeLogNeedsNewline = false;
+    }
+    changeSeq++;
+    file << "{\"seq\":" << changeSeq
+         << ",\"ts\":" << timestamp
+         << ",\"op\":" << jsonString(op)
+         << ",\"user\":" << jsonString(username)
+         << "," << payload << "}\n";
+    file.close();
+}
+
+void logUserInserted(const User& u) {
+    string record = "\"record\":{"
+        "\"nik\":" + jsonString(u.nik) +
+        ",\"name\":" + jsonString(u.name) +
+        ",\"income\":" + jsonNumber(u.income) +
+        ",\"dependents\":" + to_string(u.dependents) +
+        ",\"propertyValue\":" + jsonNumber(u.propertyValue) +
+        ",\"vehicleValue\":" + jsonNumber(u.vehicleValue) +
+        ",\"isAdmin\":" + (u.isAdmin ? "true" : "false") +
+        ",\"payment\":" + (u.payment ? "true" : "false") + "}";
+    appendChangeEvent("insert", u.username, record);
+}
+
+void logFieldChange(string_view username, const string& field, const string& oldValue, const string& newValue) {
+    appendChangeEvent("update", username,
+        "\"field\":" + jsonString(field) + ",\"old\":" + oldValue + ",\"new\":" + newValue);
+}
+
+// Bandingkan data sebelum dan sesudah, lalu catat setiap field yang berubah
+void logUserChanges(const User& before, const User& after) {
+    string_view uname = after.username;
+    if (before.name != after.name)
+        logFieldChange(uname, "name", jsonString(before.name), jsonString(after.name));
+    if (before.nik != after.nik)
+        logFieldChange(uname, "nik", jsonString(before.nik), jsonString(after.nik));
+    if (before.income != after.income)
+        logFieldChange(uname, "income", jsonNumber(before.income), jsonNumber(after.income));
+    if (before.propertyValue != after.propertyValue)
+        logFieldChange(uname, "propertyValue", jsonNumber(before.propertyValue), jsonNumber(after.propertyValue));
+    if (before.vehicleValue != after.vehicleValue)
+        logFieldChange(uname, "vehicleValue", jsonNumber(before.vehicleValue), jsonNumber(after.vehicleValue));
+    if (before.dependents != after.dependents)
+        logFieldChange(uname, "dependents", to_string(before.dependents), to_string(after.dependents));
+    if (before.password != after.password)
+        logFieldChange(uname, "password", "\"***\"", "\"***\"");
+    if (before.payment != after.payment)
+        appendChangeEvent("payment", uname,
+            string("\"old\":") + (before.payment ? "true" : "false") +
+            ",\"new\":" + (after.payment ? "true" : "false"));
+}
+
+// Simpan perubahan satu record lalu catat di log. Jika file gagal ditulis, record dikembalikan
+// ke nilai sebelumnya supaya data di memori, user.txt dan log tetap sama.
+bool saveUserChange(User& record, const User& before) {
+    if (!writeAllUsers()) {
+        record = before;
+        cout << "Perubahan gagal disimpan, data dikembalikan.\n";
+        return false;
+    }
+    logUserChanges(before, record);
+    return true;
+}
+
+// Cari posisi byte event pertama dengan seq > fromSeq (binary search, seq selalu naik)
+streamoff findChangeOffset(ifstream& file, long long fromSeq) {
+    file.seekg(0, ios::end);
+    streamoff low = 0, high = file.tellg();
+    string line;
+    while (low < high) {
+        streamoff mid = low + (high - low) / 2;
+        file.clear();
+        file.seekg(mid);
+        if (mid > 0) getline(file, line); // Lompat ke awal baris berikutnya
+
+        // Baris rusak/terpotong dilewati, pakai baris valid pertama setelahnya
+        long long seq = -1;
+        streamoff next = -1;
+        while (getline(file, line)) {
+            next = file.tellg();
+            seq = parseChangeSeq(line);
+            if (seq > 0) break;
+        }
+        if (seq <= 0) { // Tidak ada baris valid setelah mid
+            high = mid;
+            continue;
+        }
+        if (next < 0) next = high; // Baris terakhir tanpa newline
+        if (seq <= fromSeq) low = next;
+        else high = mid;
+    }
+    // low bisa berada di tengah baris, mundur ke awal baris
+    file.clear();
+    while (low > 0) {
+        file.seekg(low - 1);
+        if (file.get() == '\n') break;
+        low--;
+    }
+    return low;
+}
+
+void viewChangeLog() {
+    cout << "\n--- LOG PERUBAHAN DATA ---\n";
+    cout << "Seq terakhir: " << changeSeq << "\n";
+    cout << "Tampilkan event setelah seq: ";
+    long long fromSeq;
+    cin >> fromSeq;
+    if (cin.fail()) {
+        cout << "Input salah.\n";
+        cin.clear();
+        cin.ignore(10000, '\n');
+        return;
+    }
+    cin.ignore(10000, '\n');
+
+    ifstream file(changeLogFilename, ios::binary);
+    if (!file.is_open()) {
+        cout << "Belum ada perubahan data yang tercatat.\n";
+        return;
+    }
+
+    file.seekg(findChangeOffset(file, fromSeq));
+    string line;
+    int shown = 0;
+    while (getline(file, line)) {
+        if (parseChangeSeq(line) <= fromSeq) continue;
+        cout << line << "\n";
+        shown++;
+    }
+    cout << shown << " event ditampilkan.\n";
+}
+
+// ===== ARENA STRING RECORD =====
+char* arenaAllocate(StringArena& arena, size_t size) {
+    if (size > ARENA_BLOCK_SIZE) {
+        arena.largeBlocks.emplace_back(new char[size]);
+        return arena.largeBlocks.back().get();
+    }
+    if (arena.blocks.empty() || arena.used + size > ARENA_BLOCK_SIZE) {
+        size_t next = arena.blocks.empty() ? 0 : arena.current + 1;
+        if (next == arena.blocks.size()) arena.blocks.emplace_back(new char[ARENA_BLOCK_SIZE]);
+        arena.current = next;
+        arena.used = 0;
+    }
+    char* result = arena.blocks[arena.current].get() + arena.used;
+    arena.used += size;
+    return result;
+}
+
+ArenaString arenaStore(StringArena& arena, string_view text) {
+    ArenaString result;
+    if (text.empty()) return result;
+    char* data = arenaAllocate(arena, text.size());
+    memcpy(data, text.data(), text.size());
+    result.data = data;
+    result.length = text.size();
+    return result;
+}
+
+ArenaString arenaIntern(StringArena& arena, string_view text) {
+    if (text.size() > INTERN_MAX_LENGTH) return arenaStore(arena, text);
+
+    auto found = arena.interned.find(text);
+    if (found != arena.interned.end()) {
+        ArenaString result;
+        result.data = found->data();
+        result.length = found->size();
+        return result;
+    }
+    ArenaString result = arenaStore(arena, text);
+    arena.interned.insert(result);
+    return result;
+}
+
+// Semua ArenaString dari arena ini tidak berlaku lagi setelah reset
+void arenaReset(StringArena& arena) {
+    arena.current = 0;
+    arena.used = 0;
+    arena.largeBlocks.clear();
+    arena.interned.clear();
+}
+
 // ===== FILE HANDLING (C++ fstream, manual parsing) =====
-void parseLine(const string& line, User& u) {
-    string buffer = line;
-    size_t pos = 0;
-    string token;
-    string delimiter = "|";
-    string fields[10]; // Array untuk menampung field
+void parseLine(const string& line, User& u, StringArena& arena) {
+    size_t start[10];  // Posisi awal tiap field di line
+    size_t length[10]; // Panjang tiap field
     int count = 0;
 
-    // Pecah string berdasarkan delimiter '|'
-    while ((pos = buffer.find(delimiter)) != string::npos && count < 9) {
-        token = buffer.substr(0, pos);
-        fields[count++] = token;
-        buffer.erase(0, pos + delimiter.length());
+    // Pecah string berdasarkan delimiter '|', cukup catat posisinya tanpa membuat string baru
+    size_t begin = 0, pos;
+    while ((pos = line.find('|', begin)) != string::npos && count < 9) {
+        start[count] = begin;
+        length[count] = pos - begin;
+        count++;
+        begin = pos + 1;
     }
-    fields[count++] = buffer; // Field terakhir
-
-    // Assign ke struct User dengan penanganan error/nilai default
-    u.username = (count > 0) ? fields[0] : "";
-    u.password = (count > 1) ? fields[1] : "";
-    u.nik = (count > 2) ? fields[2] : "";
-    u.name = (count > 3) ? fields[3] : "";
-    try { u.income = (count > 4 && !fields[4].empty()) ? stod(fields[4]) : 0.0; } catch (...) { u.income = 0.0; }
-    try { u.dependents = (count > 5 && !fields[5].empty()) ? stoi(fields[5]) : 0; } catch (...) { u.dependents = 0; }
-    try { u.propertyValue = (count > 6 && !fields[6].empty()) ? stod(fields[6]) : 0.0; } catch (...) { u.propertyValue = 0.0; }
-    try { u.vehicleValue = (count > 7 && !fields[7].empty()) ? stod(fields[7]) : 0.0; } catch (...) { u.vehicleValue = 0.0; }
-    try { u.isAdmin = (count > 8 && !fields[8].empty()) ? (stoi(fields[8]) != 0) : false; } catch (...) { u.isAdmin = false; }
-    try { u.payment = (count > 9 && !fields[9].empty()) ? (stoi(fields[9]) != 0) : false; } catch (...) { u.payment = false; }
+    start[count] = begin; // Field terakhir
+    length[count] = line.size() - begin;
+    count++;
+
+    // Isi field disalin ke arena; nama dan password di-intern karena nilainya bisa berulang,
+    // username dan NIK selalu unik sehingga langsung disimpan
+    auto readText = [&](int i, bool intern) {
+        if (i >= count) return ArenaString();
+        string_view text = string_view(line).substr(start[i], length[i]);
+        return intern ? arenaIntern(arena, text) : arenaStore(arena, text);
+    };
+    // Field kosong, tidak valid atau di luar jangkauan bernilai 0 (sama seperti stod/stoi dulu)
+    auto readNumber = [&](int i) {
+        if (i >= count || length[i] == 0) return 0.0;
+        errno = 0;
+        double value = strtod(line.c_str() + start[i], nullptr);
+        return (errno == ERANGE) ? 0.0 : value;
+    };
+    auto readInteger = [&](int i) {
+        if (i >= count || length[i] == 0) return 0;
+        errno = 0;
+        long value = strtol(line.c_str() + start[i], nullptr, 10);
+        if (errno == ERANGE || value < INT_MIN || value > INT_MAX) return 0;
+        return (int)value;
+    };
+
+    u.username = readText(0, false);
+    u.password = readText(1, true);
+    u.nik = readText(2, false);
+    u.name = readText(3, true);
+    u.income = readNumber(4);
+    u.dependents = readInteger(5);
+    u.propertyValue = readNumber(6);
+    u.vehicleValue = readNumber(7);
+    u.isAdmin = readInteger(8) != 0;
+    u.payment = readInteger(9) != 0;
+    u.regionCode = parseRegionCode(u.nik); // Dihitung sekali saat load
 }
 
 void readAllUsers() {
     ifstream file(filename);
     string line;
     userCount = 0;
+    unloadedTailOffset = -1;
+    arenaReset(userArena); // Load baru, string dari load sebelumnya tidak dipakai lagi
 
     if (!file.is_open()) {
         // Jika file tidak ada, tidak apa-apa
         return;
     }
 
-    while (getline(file, line) && userCount < MAX_USERS) {
+    while (userCount < MAX_USERS && getline(file, line)) {
         if (!line.empty()) {
-            parseLine(line, users[userCount]);
+            parseLine(line, users[userCount], userArena);
             userCount++;
         }
     }
-    file.close();
-}
 
-void writeAllUsers() {
-    ofstream file(filename, ios::trunc); // Overwrite
-    if (!file.is_open()) {
-        cerr << "Error: Tidak bisa membuka file " << filename << " untuk ditulis.\n";
-        return;
+    // Record sisa yang tidak muat tidak dimuat, tapi posisinya dicatat supaya
+    // writeAllUsers() tetap menyalinnya dan tidak ada data yang hilang
+    if (userCount == MAX_USERS) {
+        streamoff pos = file.tellg();
+        while (pos >= 0 && getline(file, line)) {
+            if (!line.empty()) {
+                unloadedTailOffset = pos;
+                cout << "Catatan: " << filename << " berisi lebih dari " << MAX_USERS
+                     << " user. Hanya " << MAX_USERS << " user pertama yang dimuat, "
+                     << "gunakan Mode Out-of-Core untuk seluruh data.\n";
+                break;
+            }
+            pos = file.tellg();
+        }
     }
+    file.close();
+}
 
+void writeUserRecords(ostream& file) {
     for (int i = 0; i < userCount; i++) {
         file << users[i].username << "|"
              << users[i].password << "|"
@@ -718,38 +1599,404 @@ void writeAllUsers() {
              << users[i].isAdmin << "|"
              << users[i].payment << "\n";
     }
+}
+
+// Tulis ulang user.txt jika ada record yang tidak dimuat: record di memori ditulis ke file
+// sementara, sisa file lama disalin apa adanya, lalu file sementara menggantikan user.txt
+bool writeAllUsersWithTail() {
+    string tempFilename = filename + ".tmp";
+    ifstream source(filename);
+    ofstream file(tempFilename, ios::trunc);
+    if (!source.is_open() || !file.is_open()) {
+        cerr << "Error: Tidak bisa membuka file " << filename << " untuk ditulis.\n";
+        return false;
+    }
+
+    writeUserRecords(file);
+    streamoff newTailOffset = file.tellp();
+    source.seekg(unloadedTailOffset);
+    file << source.rdbuf();
+    source.close();
+    file.close();
+    if (source.bad() || file.fail() || newTailOffset < 0) {
+        cerr << "Error: Gagal menulis file " << filename << ".\n";
+        remove(tempFilename.c_str());
+        return false;
+    }
+
+    if (rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        remove(filename.c_str()); // Windows tidak bisa rename menimpa file yang ada
+        if (rename(tempFilename.c_str(), filename.c_str()) != 0) {
+            cerr << "Error: Gagal mengganti file " << filename << ".\n";
+            return false;
+        }
+    }
+    unloadedTailOffset = newTailOffset;
+    return true;
+}
+
+bool writeAllUsers() {
+    if (unloadedTailOffset >= 0) return writeAllUsersWithTail();
+
+    ofstream file(filename, ios::trunc); // Overwrite
+    if (!file.is_open()) {
+        cerr << "Error: Tidak bisa membuka file " << filename << " untuk ditulis.\n";
+        return false;
+    }
+
+    writeUserRecords(file);
     file.close();
+    if (file.fail()) {
+        cerr << "Error: Gagal menulis file " << filename << ".\n";
+        return false;
+    }
+    return true;
+}
+
+// ===== MODE OUT-OF-CORE (DATA BESAR) =====
+// Data user.txt dibaca per potongan (chunk) tanpa batas MAX_USERS. Ukuran potongan dihitung
+// dari batas memori; dua buffer dipakai bergantian sehingga potongan berikutnya dibaca di
+// thread I/O selagi potongan sekarang diproses.
+
+struct UserChunkStream {
+    ifstream file;
+    vector<User> buffers[2];
+    StringArena arenas[2]; // String record tiap buffer, direset setiap potongan baru dibaca
+    int filled[2] = {0, 0};
+    int loadingSlot = 0; // Buffer yang sedang diisi thread I/O
+    thread ioThread;
+    int chunksRead = 0;
+};
+
+int chunkRecordLimit() {
+    // Tiga bagian: dua buffer baca + satu untuk data olahan (mis. run sorting)
+    long long records = memoryBudgetBytes / (3 * (long long)APPROX_RECORD_BYTES);
+    return (int)max(1LL, min(records, 10000000LL));
+}
+
+void readChunk(ifstream& file, vector<User>& buffer, StringArena& arena, int& filled) {
+    string line;
+    filled = 0;
+    arenaReset(arena);
+    while (filled < (int)buffer.size() && getline(file, line)) {
+        if (!line.empty()) {
+            parseLine(line, buffer[filled], arena);
+            filled++;
+        }
+    }
+}
+
+void startPrefetch(UserChunkStream& stream, int slot) {
+    stream.loadingSlot = slot;
+    stream.ioThread = thread(readChunk, ref(stream.file), ref(stream.buffers[slot]),
+                             ref(stream.arenas[slot]), ref(stream.filled[slot]));
+}
+
+bool openChunkStream(UserChunkStream& stream) {
+    stream.file.open(filename);
+    if (!stream.file.is_open()) return false;
+
+    int limit = chunkRecordLimit();
+    stream.buffers[0].resize(limit);
+    stream.buffers[1].resize(limit);
+    startPrefetch(stream, 0);
+    return true;
+}
+
+// Ambil potongan yang sudah dibaca, lalu langsung mulai membaca potongan berikutnya.
+// Data yang dikembalikan berlaku sampai nextChunk dipanggil lagi.
+bool nextChunk(UserChunkStream& stream, const User*& data, int& count) {
+    if (!stream.ioThread.joinable()) return false;
+    stream.ioThread.join();
+
+    int slot = stream.loadingSlot;
+    count = stream.filled[slot];
+    if (count == 0) return false;
+
+    if (count == (int)stream.buffers[slot].size()) {
+        startPrefetch(stream, 1 - slot); // Mungkin masih ada data
+    }
+    data = stream.buffers[slot].data();
+    stream.chunksRead++;
+    return true;
+}
+
+void closeChunkStream(UserChunkStream& stream) {
+    if (stream.ioThread.joinable()) stream.ioThread.join();
+    stream.file.close();
+}
+
+void recomputeTaxOutOfCore() {
+    UserChunkStream stream;
+    if (!openChunkStream(stream)) {
+        cout << "File " << filename << " tidak ditemukan.\n";
+        return;
+    }
+    ofstream out(recomputeFilename, ios::trunc);
+    if (!out.is_open()) {
+        cerr << "Error: Tidak bisa membuka file " << recomputeFilename << " untuk ditulis.\n";
+        closeChunkStream(stream);
+        return;
+    }
+
+    long long records = 0, taxpayers = 0, paidTaxpayers = 0;
+    double taxDue = 0, taxCollected = 0;
+    const User* data;
+    int count;
+    out << fixed << setprecision(2);
+    while (nextChunk(stream, data, count)) {
+        for (int i = 0; i < count; i++) {
+            const User& u = data[i];
+            if (u.isAdmin) continue;
+            records++;
+            double tax = calculateTotalTax(u);
+            out << u.username << "|" << u.nik << "|" << tax << "|" << u.payment << "\n";
+            if (!isRequiredToPayTax(u)) continue;
+            taxpayers++;
+            taxDue += tax;
+            if (u.payment) {
+                paidTaxpayers++;
+                taxCollected += tax;
+            }
+        }
+    }
+    closeChunkStream(stream);
+    out.close();
+
+    cout << "Hasil hitung ulang disimpan ke " << recomputeFilename << "\n";
+    cout << "Potongan diproses : " << stream.chunksRead << " (maks " << chunkRecordLimit() << " record/potongan)\n";
+    cout << "User              : " << records << "\n";
+    cout << "Wajib pajak       : " << taxpayers << " (" << paidTaxpayers << " sudah bayar)\n";
+    cout << "Total terutang    : Rp " << fixed << setprecision(2) << taxDue << "\n";
+    cout << "Total terbayar    : Rp " << taxCollected << "\n";
+    cout << "Total tunggakan   : Rp " << (taxDue - taxCollected) << "\n";
+}
+
+// Satu baris ranking: "pajak|username|nama"
+struct RankEntry {
+    double tax = 0;
+    string username;
+    string name;
+};
+
+bool readRankEntry(ifstream& file, RankEntry& entry) {
+    string line;
+    if (!getline(file, line)) return false;
+    size_t first = line.find('|');
+    size_t second = line.find('|', first + 1);
+    try { entry.tax = stod(line.substr(0, first)); } catch (...) { entry.tax = 0; }
+    entry.username = line.substr(first + 1, second - first - 1);
+    entry.name = (second == string::npos) ? "" : line.substr(second + 1);
+    return true;
+}
+
+// Satu-satunya tempat format baris ranking ditulis, harus cocok dengan readRankEntry
+void writeRankLine(ofstream& file, double tax, string_view username, string_view name) {
+    file << fixed << setprecision(2) << tax << "|" << username << "|" << name << "\n";
+}
+
+void writeRankEntry(ofstream& file, const RankEntry& entry) {
+    writeRankLine(file, entry.tax, entry.username, entry.name);
+}
+
+void writeRankEntry(ofstream& file, double tax, const User& user) {
+    writeRankLine(file, tax, user.username, user.name);
+}
+
+// Gabungkan beberapa run yang sudah terurut (pajak terbesar dulu) menjadi satu file
+void mergeRankRuns(const vector<string>& runs, const string& output) {
+    vector<ifstream> inputs(runs.size());
+    vector<RankEntry> heads(runs.size());
+    // Urut pajak terbesar, jika sama run yang lebih awal didahulukan (stabil)
+    auto lowerPriority = [&heads](size_t a, size_t b) {
+        if (heads[a].tax != heads[b].tax) return heads[a].tax < heads[b].tax;
+        return a > b;
+    };
+    priority_queue<size_t, vector<size_t>, decltype(lowerPriority)> queue(lowerPriority);
+    for (size_t r = 0; r < runs.size(); r++) {
+        inputs[r].open(runs[r]);
+        if (readRankEntry(inputs[r], heads[r])) queue.push(r);
+    }
+
+    ofstream out(output, ios::trunc);
+    while (!queue.empty()) {
+        size_t r = queue.top();
+        queue.pop();
+        writeRankEntry(out, heads[r]);
+        if (readRankEntry(inputs[r], heads[r])) queue.push(r);
+    }
+    out.close();
+    for (size_t r = 0; r < runs.size(); r++) {
+        inputs[r].close();
+        remove(runs[r].c_str());
+    }
+}
+
+// Merge sort eksternal: tiap potongan diurutkan di memori lalu ditulis sebagai run,
+// kemudian run digabung bertahap (maks MAX_MERGE_FAN_IN file sekaligus).
+void sortUsersByTaxOutOfCore() {
+    UserChunkStream stream;
+    if (!openChunkStream(stream)) {
+        cout << "File " << filename << " tidak ditemukan.\n";
+        return;
+    }
+
+    vector<string> runs;
+    vector<int> order;    // Indeks record di potongan, yang diurutkan hanya indeksnya
+    vector<double> taxes;
+    const User* data;
+    int count;
+    while (nextChunk(stream, data, count)) {
+        order.clear();
+        taxes.resize(count);
+        for (int i = 0; i < count; i++) {
+            if (data[i].isAdmin) continue;
+            taxes[i] = calculateTotalTax(data[i]);
+            order.push_back(i);
+        }
+        stable_sort(order.begin(), order.end(), [&taxes](int a, int b) {
+            return taxes[a] > taxes[b];
+        });
+
+        string runName = rankingFilename + ".run" + to_string(runs.size());
+        ofstream run(runName, ios::trunc);
+        for (size_t i = 0; i < order.size(); i++) {
+            writeRankEntry(run, taxes[order[i]], data[order[i]]);
+        }
+        run.close();
+        runs.push_back(runName);
+    }
+    closeChunkStream(stream);
+
+    int pass = 0;
+    while (runs.size() > MAX_MERGE_FAN_IN) {
+        vector<string> merged;
+        for (size_t start = 0; start < runs.size(); start += MAX_MERGE_FAN_IN) {
+            size_t end = min(runs.size(), start + MAX_MERGE_FAN_IN);
+            string mergedName = rankingFilename + ".pass" + to_string(pass) + "." + to_string(merged.size());
+            mergeRankRuns(vector<string>(runs.begin() + start, runs.begin() + end), mergedName);
+            merged.push_back(mergedName);
+        }
+        runs = merged;
+        pass++;
+    }
+    mergeRankRuns(runs, rankingFilename);
+
+    cout << "\n--- USER BERDASARKAN PAJAK (TERBESAR KE TERKECIL) ---\n";
+    cout << left << setw(15) << "Username"
+         << setw(25) << "Nama Lengkap"
+         << setw(20) << "Total Pajak (Rp)" << endl;
+    cout << string(60, '-') << endl;
+    ifstream ranking(rankingFilename);
+    RankEntry entry;
+    for (int i = 0; i < RANKING_PREVIEW && readRankEntry(ranking, entry); i++) {
+        cout << left << setw(15) << entry.username
+             << setw(25) << entry.name
+             << setw(20) << fixed << setprecision(2) << entry.tax << endl;
+    }
+    cout << string(60, '-') << endl;
+    cout << "Ranking lengkap disimpan ke " << rankingFilename << "\n";
+}
+
+void viewRegionalReportOutOfCore() {
+    int level = askRegionLevel();
+    if (level == 0) return;
+
+    UserChunkStream stream;
+    if (!openChunkStream(stream)) {
+        cout << "File " << filename << " tidak ditemukan.\n";
+        return;
+    }
+
+    // Hanya ringkasan per wilayah yang disimpan, bukan data user
+    int divisor = (level == 1) ? 10000 : (level == 2 ? 100 : 1);
+    unordered_map<int, RegionStats> stats;
+    const User* data;
+    int count;
+    while (nextChunk(stream, data, count)) {
+        aggregateRegions(data, count, divisor, stats);
+    }
+    closeChunkStream(stream);
+    printRegionalReport(stats, level);
+}
+
+void showOutOfCoreMenu() {
+    int ch;
+    while (true) {
+        cout << "\n--- MODE OUT-OF-CORE ---\n";
+        cout << "Batas memori: " << memoryBudgetBytes / (1024 * 1024) << " MB ("
+             << chunkRecordLimit() << " record/potongan)\n";
+        cout << "1. Hitung Ulang Pajak Semua User\n";
+        cout << "2. Ranking User Berdasarkan Pajak\n";
+        cout << "3. Laporan Pajak Per Wilayah\n";
+        cout << "4. Atur Batas Memori\n";
+        cout << "5. Kembali\n";
+        cout << "Pilih: ";
+        cin >> ch;
+        if (cin.fail()) { cout << "Input salah.\n"; cin.clear(); cin.ignore(10000, '\n'); continue; }
+        cin.ignore(10000, '\n');
+
+        switch (ch) {
+            case 1: recomputeTaxOutOfCore(); break;
+            case 2: sortUsersByTaxOutOfCore(); break;
+            case 3: viewRegionalReportOutOfCore(); break;
+            case 4: {
+                cout << "Batas memori baru (MB): ";
+                long long megabytes;
+                cin >> megabytes;
+                if (cin.fail() || megabytes <= 0) {
+                    cout << "Input salah.\n";
+                    cin.clear();
+                } else {
+                    memoryBudgetBytes = megabytes * 1024 * 1024;
+                }
+                cin.ignore(10000, '\n');
+                break;
+            }
+            case 5: return;
+            default: cout << "Pilihan salah.\n";
+        }
+    }
 }
 
 // ===== TAX CALCULATION (Sama seperti sebelumnya) =====
 double calculateTaxPPh21(double monthlyIncome, int dependents) {
+    return calculateTaxPPh21WithRules(monthlyIncome, dependents, currentTaxRules);
+}
+
+// Tarif progresif: tiap lapisan dikenakan tarifnya sendiri
+double calculateTaxPPh21WithRules(double monthlyIncome, int dependents, const TaxRules& rules) {
     double annualIncome = monthlyIncome * 12;
-    int maxDependents = min(dependents, 3);
-    double ptkp = 54000000 + (maxDependents * 4500000);
+    int maxDependents = min(dependents, rules.maxDependents);
+    double ptkp = rules.ptkpBase + (maxDependents * rules.ptkpPerDependent);
     double pkp = annualIncome - ptkp;
     if (pkp <= 0) return 0;
     double tax = 0;
-    if (pkp <= 60000000) tax = pkp * 0.05;
-    else if (pkp <= 250000000) tax = (60000000 * 0.05) + ((pkp - 60000000) * 0.15);
-    else if (pkp <= 500000000) tax = (60000000 * 0.05) + (190000000 * 0.15) + ((pkp - 250000000) * 0.25);
-    else if (pkp <= 5000000000) tax = (60000000 * 0.05) + (190000000 * 0.15) + (250000000 * 0.25) + ((pkp - 500000000) * 0.30);
-    else tax = (60000000 * 0.05) + (190000000 * 0.15) + (250000000 * 0.25) + (4500000000 * 0.30) + ((pkp - 5000000000) * 0.35);
+    double lower = 0;
+    for (int i = 0; i < PPH21_BRACKETS - 1 && pkp > lower; i++) {
+        double upper = rules.bracketLimits[i];
+        tax += (min(pkp, upper) - lower) * rules.bracketRates[i];
+        lower = upper;
+    }
+    if (pkp > lower) tax += (pkp - lower) * rules.bracketRates[PPH21_BRACKETS - 1];
     return tax;
 }
 
 double calculatePropertyTax(double propertyValue) {
-    return 0.001 * propertyValue;
+    return currentTaxRules.propertyRate * propertyValue;
 }
 
 double calculateVehicleTax(double vehicleValue) {
-    return 0.02 * vehicleValue;
+    return currentTaxRules.vehicleRate * vehicleValue;
+}
+
+double calculateTotalTaxWithRules(const User& user, const TaxRules& rules) {
+    double pph21 = (user.income < rules.exemptIncome) ? 0 : calculateTaxPPh21WithRules(user.income, user.dependents, rules);
+    return pph21 + rules.propertyRate * user.propertyValue + rules.vehicleRate * user.vehicleValue;
 }
 
 double calculateTotalTax(const User& user) {
-    double pph21 = isExemptedFromPPh21(user) ? 0 : calculateTaxPPh21(user.income, user.dependents);
-    double propertyTax = calculatePropertyTax(user.propertyValue);
-    double vehicleTax = calculateVehicleTax(user.vehicleValue);
-    return pph21 + propertyTax + vehicleTax;
+    return calculateTotalTaxWithRules(user, currentTaxRules);
 }
 
 // Fungsi komparator untuk std::sort